@@ -0,0 +1,573 @@
+/*
+ * Copyright (c) 2025 BitFigther
+ * Licensed under the MIT License
+ */
+
+#include "libfm.h"
+
+#include <errno.h>
+#include <fnmatch.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <ftw.h>
+#include <openssl/evp.h>
+#include <openssl/md5.h>
+
+#define BASELINE_MAGIC "FMBL"
+#define BASELINE_MAGIC_LEN 4
+#define BASELINE_VERSION ((uint32_t)1)
+#define FM_ERRBUF_SIZE 512
+
+_Static_assert(FM_MD5_LEN == MD5_DIGEST_LENGTH, "FM_MD5_LEN must match MD5_DIGEST_LENGTH");
+
+// Structure to store baseline file information
+typedef struct {
+    char *filepath;
+    time_t mtime;
+    off_t size;
+    unsigned char md5[MD5_DIGEST_LENGTH];
+} FileInfo;
+
+/* Hash table entry: maps filepath to baseline array index */
+typedef struct {
+    const char *key; /* points to baseline[idx].filepath; NULL = empty slot */
+    int idx;
+} HashEntry;
+
+enum { FM_MODE_IDLE, FM_MODE_BASELINE, FM_MODE_CHECK };
+
+struct fm_ctx {
+    FileInfo *baseline;
+    int baseline_count;
+    int baseline_capacity;
+    time_t baseline_time;
+    char **exclude_patterns;
+    int exclude_patterns_count;
+    int *file_checked;
+    HashEntry *hash_table;
+    int hash_table_size;
+    int index_stale; /* baseline changed since hash_table/file_checked were built */
+    int mode;
+    fm_stats stats;
+    fm_event_cb cb;
+    void *cb_user;
+    fm_results *collect; /* non-NULL while fm_check_paths() is batching events */
+    int collect_failed;
+    char errbuf[FM_ERRBUF_SIZE];
+};
+
+/*
+ * nftw() has no user-data argument, so the context being walked is passed to
+ * the callback through a thread-local. Each thread can walk its own context.
+ */
+static __thread fm_ctx *walk_ctx = NULL;
+
+static int set_error(fm_ctx *ctx, int code, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(ctx->errbuf, sizeof(ctx->errbuf), fmt, ap);
+    va_end(ap);
+    return code;
+}
+
+static uint32_t fnv1a_hash(const char *str) {
+    uint32_t hash = 2166136261u;
+    while (*str) {
+        hash ^= (uint8_t)*str++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* Build hash table and seen flags from the current baseline array. */
+static int hash_table_build(fm_ctx *ctx) {
+    free(ctx->hash_table);
+    ctx->hash_table = NULL;
+    free(ctx->file_checked);
+    ctx->file_checked = calloc(ctx->baseline_count > 0 ? ctx->baseline_count : 1, sizeof(int));
+    if (!ctx->file_checked) return 0;
+    /* Use table size = next power-of-2 >= 2*baseline_count to keep load < 0.5 */
+    ctx->hash_table_size = 1024;
+    while ((size_t)ctx->hash_table_size < (size_t)ctx->baseline_count * 2) ctx->hash_table_size *= 2;
+    ctx->hash_table = calloc(ctx->hash_table_size, sizeof(HashEntry));
+    if (!ctx->hash_table) return 0;
+    uint32_t mask = (uint32_t)ctx->hash_table_size - 1;
+    for (int i = 0; i < ctx->baseline_count; i++) {
+        uint32_t h = fnv1a_hash(ctx->baseline[i].filepath) & mask;
+        while (ctx->hash_table[h].key != NULL) h = (h + 1) & mask;
+        ctx->hash_table[h].key = ctx->baseline[i].filepath;
+        ctx->hash_table[h].idx = i;
+    }
+    ctx->index_stale = 0;
+    return 1;
+}
+
+/* Look up filepath in the hash table. Returns index into baseline[], or -1 if not found. */
+static int hash_table_lookup(const fm_ctx *ctx, const char *filepath) {
+    if (!ctx->hash_table) return -1;
+    uint32_t mask = (uint32_t)ctx->hash_table_size - 1;
+    uint32_t h = fnv1a_hash(filepath) & mask;
+    while (ctx->hash_table[h].key != NULL) {
+        if (strcmp(ctx->hash_table[h].key, filepath) == 0) return ctx->hash_table[h].idx;
+        h = (h + 1) & mask;
+    }
+    return -1;
+}
+
+/*
+ * Returns 1 if fpath matches any user-specified exclude pattern.
+ * Each pattern is matched against the full path and against the basename,
+ * using fnmatch() so that glob patterns like "*.tmp" or "/var/log/\*" work.
+ * The match is attempted with FNM_PATHNAME so that "*" does not cross "/"
+ * when the pattern contains a slash; without FNM_PATHNAME otherwise.
+ */
+static int is_user_excluded(const fm_ctx *ctx, const char *fpath) {
+    const char *basename = strrchr(fpath, '/');
+    basename = basename ? basename + 1 : fpath;
+
+    for (int i = 0; i < ctx->exclude_patterns_count; i++) {
+        const char *pat = ctx->exclude_patterns[i];
+        int flags = strchr(pat, '/') ? FNM_PATHNAME : 0;
+        if (fnmatch(pat, fpath, flags) == 0 ||
+            fnmatch(pat, basename, 0) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Returns:  1 on success,
+ *          -1 if file cannot be opened (permission/not found),
+ *           0 if hash computation fails.
+ */
+static int calculate_md5(const char *filepath, unsigned char *result) {
+    FILE *file = fopen(filepath, "rb");
+    if (!file) {
+        return -1;
+    }
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    if (!ctx) {
+        fclose(file);
+        return 0;
+    }
+    if (EVP_DigestInit_ex(ctx, EVP_md5(), NULL) != 1) {
+        EVP_MD_CTX_free(ctx);
+        fclose(file);
+        return 0;
+    }
+    unsigned char buffer[8192];
+    size_t bytes_read;
+    while ((bytes_read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        if (EVP_DigestUpdate(ctx, buffer, bytes_read) != 1) {
+            EVP_MD_CTX_free(ctx);
+            fclose(file);
+            return 0;
+        }
+    }
+    unsigned int md_len;
+    if (EVP_DigestFinal_ex(ctx, result, &md_len) != 1) {
+        EVP_MD_CTX_free(ctx);
+        fclose(file);
+        return 0;
+    }
+    EVP_MD_CTX_free(ctx);
+    fclose(file);
+    return 1;
+}
+
+void fm_md5_to_string(const unsigned char *md5, char *output) {
+    for (int i = 0; i < MD5_DIGEST_LENGTH; i++) {
+        sprintf(output + (i * 2), "%02x", md5[i]);
+    }
+    output[MD5_DIGEST_LENGTH * 2] = '\0';
+}
+
+static int results_append(fm_results *res, const fm_event *ev) {
+    if (res->count >= res->capacity) {
+        size_t cap = res->capacity == 0 ? 64 : res->capacity * 2;
+        fm_event *tmp = realloc(res->events, cap * sizeof(fm_event));
+        if (!tmp) return 0;
+        res->events = tmp;
+        res->capacity = cap;
+    }
+    char *path = strdup(ev->path);
+    if (!path) return 0;
+    res->events[res->count] = *ev;
+    res->events[res->count].path = path;
+    res->count++;
+    return 1;
+}
+
+static void emit(fm_ctx *ctx, const fm_event *ev) {
+    if (ctx->collect && !ctx->collect_failed && !results_append(ctx->collect, ev)) {
+        ctx->collect_failed = 1;
+    }
+    if (ctx->cb) ctx->cb(ev, ctx->cb_user);
+}
+
+static int add_file_info(fm_ctx *ctx, const char *filepath, time_t mtime, off_t size, const unsigned char *md5) {
+    if (ctx->baseline_count >= ctx->baseline_capacity) {
+        int cap = ctx->baseline_capacity == 0 ? 1000 : ctx->baseline_capacity * 2;
+        FileInfo *tmp = realloc(ctx->baseline, cap * sizeof(FileInfo));
+        if (!tmp) return 0;
+        ctx->baseline = tmp;
+        ctx->baseline_capacity = cap;
+    }
+    FileInfo *fi = &ctx->baseline[ctx->baseline_count];
+    fi->filepath = strdup(filepath);
+    if (!fi->filepath) return 0;
+    fi->mtime = mtime;
+    fi->size = size;
+    memcpy(fi->md5, md5, MD5_DIGEST_LENGTH);
+    ctx->baseline_count++;
+    ctx->index_stale = 1;
+    return 1;
+}
+
+static int scan_file(const char *fpath, const struct stat *sb, int typeflag, struct FTW *ftwbuf) {
+    (void)ftwbuf;
+    fm_ctx *ctx = walk_ctx;
+    if (typeflag != FTW_F) {
+        return 0;
+    }
+    if (is_user_excluded(ctx, fpath)) {
+        return 0;
+    }
+    /* Auto-exclude system paths that are unsafe or irrelevant to scan */
+    if (strncmp(fpath, "/tmp/", 5) == 0 ||
+        strncmp(fpath, "/var/log/", 9) == 0 ||
+        strncmp(fpath, "/proc/", 6) == 0 ||
+        strncmp(fpath, "/sys/", 5) == 0 ||
+        strncmp(fpath, "/dev/", 5) == 0) {
+        return 0;
+    }
+    fm_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.path = fpath;
+    int md5_ret = calculate_md5(fpath, ev.new_md5);
+    if (md5_ret != 1) {
+        ev.type = md5_ret == -1 ? FM_EVENT_UNREADABLE : FM_EVENT_HASH_FAILED;
+        memset(ev.new_md5, 0, sizeof(ev.new_md5));
+        ctx->stats.unverified++;
+        emit(ctx, &ev);
+        return 0;
+    }
+    ctx->stats.files_scanned++;
+    if (ctx->mode == FM_MODE_BASELINE) {
+        if (!add_file_info(ctx, fpath, sb->st_mtime, sb->st_size, ev.new_md5)) {
+            errno = ENOMEM;
+            return -1;
+        }
+        return 0;
+    }
+    ev.new_mtime = sb->st_mtime;
+    ev.new_size = sb->st_size;
+    int idx = hash_table_lookup(ctx, fpath);
+    if (idx >= 0) {
+        ctx->file_checked[idx] = 1;
+        const FileInfo *existing = &ctx->baseline[idx];
+        if (memcmp(existing->md5, ev.new_md5, MD5_DIGEST_LENGTH) != 0) ev.changed |= FM_CHANGED_MD5;
+        if (existing->mtime != sb->st_mtime) ev.changed |= FM_CHANGED_MTIME;
+        if (existing->size != sb->st_size) ev.changed |= FM_CHANGED_SIZE;
+        if (ev.changed) {
+            ev.type = FM_EVENT_CHANGED;
+            ev.old_mtime = existing->mtime;
+            ev.old_size = existing->size;
+            memcpy(ev.old_md5, existing->md5, MD5_DIGEST_LENGTH);
+            ctx->stats.changed++;
+            emit(ctx, &ev);
+        }
+    } else {
+        ev.type = FM_EVENT_NEW;
+        ctx->stats.added++;
+        emit(ctx, &ev);
+    }
+    return 0;
+}
+
+static int walk(fm_ctx *ctx, const char *dir) {
+    fm_ctx *saved = walk_ctx;
+    walk_ctx = ctx;
+    int r = nftw(dir, scan_file, 20, FTW_PHYS);
+    int saved_errno = errno;
+    walk_ctx = saved;
+    if (r == -1) {
+        if (saved_errno == ENOMEM) return set_error(ctx, FM_ERR_NOMEM, "Memory allocation error");
+        return set_error(ctx, FM_ERR_SCAN, "Directory scan error: %s", strerror(saved_errno));
+    }
+    return FM_OK;
+}
+
+fm_ctx *fm_ctx_new(void) {
+    return calloc(1, sizeof(fm_ctx));
+}
+
+void fm_ctx_free(fm_ctx *ctx) {
+    if (!ctx) return;
+    fm_baseline_clear(ctx);
+    fm_clear_exclude_patterns(ctx);
+    free(ctx);
+}
+
+const char *fm_last_error(const fm_ctx *ctx) {
+    return ctx->errbuf;
+}
+
+int fm_add_exclude_patterns(fm_ctx *ctx, const char *csv) {
+    char *copy = strdup(csv);
+    if (!copy) return set_error(ctx, FM_ERR_NOMEM, "Memory allocation error (strdup)");
+    char *saveptr = NULL;
+    char *token = strtok_r(copy, ",", &saveptr);
+    while (token) {
+        char **tmp = realloc(ctx->exclude_patterns, sizeof(char*) * (ctx->exclude_patterns_count + 1));
+        if (!tmp) {
+            free(copy);
+            return set_error(ctx, FM_ERR_NOMEM, "Memory allocation error (realloc)");
+        }
+        ctx->exclude_patterns = tmp;
+        char *p = strdup(token);
+        if (!p) {
+            free(copy);
+            return set_error(ctx, FM_ERR_NOMEM, "Memory allocation error (strdup)");
+        }
+        ctx->exclude_patterns[ctx->exclude_patterns_count++] = p;
+        token = strtok_r(NULL, ",", &saveptr);
+    }
+    free(copy);
+    return FM_OK;
+}
+
+void fm_clear_exclude_patterns(fm_ctx *ctx) {
+    for (int i = 0; i < ctx->exclude_patterns_count; i++) free(ctx->exclude_patterns[i]);
+    free(ctx->exclude_patterns);
+    ctx->exclude_patterns = NULL;
+    ctx->exclude_patterns_count = 0;
+}
+
+void fm_set_event_callback(fm_ctx *ctx, fm_event_cb cb, void *user) {
+    ctx->cb = cb;
+    ctx->cb_user = user;
+}
+
+void fm_baseline_clear(fm_ctx *ctx) {
+    for (int i = 0; i < ctx->baseline_count; i++) free(ctx->baseline[i].filepath);
+    free(ctx->baseline);
+    ctx->baseline = NULL;
+    ctx->baseline_count = 0;
+    ctx->baseline_capacity = 0;
+    ctx->baseline_time = 0;
+    free(ctx->file_checked);
+    ctx->file_checked = NULL;
+    free(ctx->hash_table);
+    ctx->hash_table = NULL;
+    ctx->hash_table_size = 0;
+    ctx->index_stale = 1;
+    ctx->mode = FM_MODE_IDLE;
+}
+
+int fm_baseline_count(const fm_ctx *ctx) {
+    return ctx->baseline_count;
+}
+
+time_t fm_baseline_time(const fm_ctx *ctx) {
+    return ctx->baseline_time;
+}
+
+int fm_baseline_scan(fm_ctx *ctx, const char *dir) {
+    if (ctx->mode != FM_MODE_BASELINE) {
+        memset(&ctx->stats, 0, sizeof(ctx->stats));
+        ctx->mode = FM_MODE_BASELINE;
+    }
+    int r = walk(ctx, dir);
+    ctx->baseline_time = time(NULL);
+    return r;
+}
+
+int fm_baseline_save(fm_ctx *ctx, const char *path) {
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        return set_error(ctx, FM_ERR_IO, "Failed to create baseline file: %s", path);
+    }
+    int write_err = 0;
+    /* Header: magic + version + timestamp + count */
+    uint32_t version = BASELINE_VERSION;
+    time_t current_time = time(NULL);
+    if (fwrite(BASELINE_MAGIC, BASELINE_MAGIC_LEN, 1, fp) != 1 ||
+        fwrite(&version, sizeof(uint32_t), 1, fp) != 1 ||
+        fwrite(&current_time, sizeof(time_t), 1, fp) != 1 ||
+        fwrite(&ctx->baseline_count, sizeof(int), 1, fp) != 1) {
+        write_err = 1;
+    }
+    for (int i = 0; i < ctx->baseline_count && !write_err; i++) {
+        const FileInfo *fi = &ctx->baseline[i];
+        int path_len = strlen(fi->filepath) + 1;
+        if (fwrite(&path_len, sizeof(int), 1, fp) != 1 ||
+            fwrite(fi->filepath, path_len, 1, fp) != 1 ||
+            fwrite(&fi->mtime, sizeof(time_t), 1, fp) != 1 ||
+            fwrite(&fi->size, sizeof(off_t), 1, fp) != 1 ||
+            fwrite(fi->md5, MD5_DIGEST_LENGTH, 1, fp) != 1) {
+            write_err = 1;
+        }
+    }
+    if (fclose(fp) != 0) write_err = 1;
+    if (write_err) {
+        return set_error(ctx, FM_ERR_IO, "Failed to write baseline file: %s", path);
+    }
+    return FM_OK;
+}
+
+int fm_baseline_load(fm_ctx *ctx, const char *path) {
+    fm_baseline_clear(ctx);
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return set_error(ctx, FM_ERR_NOENT, "Baseline file '%s' not found", path);
+    }
+    /* Validate header: magic + version */
+    char magic[BASELINE_MAGIC_LEN];
+    uint32_t version;
+    int count;
+    if (fread(magic, BASELINE_MAGIC_LEN, 1, fp) != 1 ||
+        memcmp(magic, BASELINE_MAGIC, BASELINE_MAGIC_LEN) != 0) {
+        fclose(fp);
+        return set_error(ctx, FM_ERR_FORMAT, "Baseline file '%s' has invalid format (bad magic).", path);
+    }
+    if (fread(&version, sizeof(uint32_t), 1, fp) != 1) {
+        fclose(fp);
+        return set_error(ctx, FM_ERR_FORMAT, "Baseline file '%s' is truncated.", path);
+    }
+    if (version != BASELINE_VERSION) {
+        fclose(fp);
+        return set_error(ctx, FM_ERR_FORMAT, "Baseline file '%s' has unsupported version %u (expected %u).",
+                         path, version, BASELINE_VERSION);
+    }
+    if (fread(&ctx->baseline_time, sizeof(time_t), 1, fp) != 1 ||
+        fread(&count, sizeof(int), 1, fp) != 1 || count < 0) {
+        fclose(fp);
+        ctx->baseline_time = 0;
+        return set_error(ctx, FM_ERR_FORMAT, "Baseline file '%s' is corrupted (truncated header).", path);
+    }
+    ctx->baseline = calloc(count > 0 ? count : 1, sizeof(FileInfo));
+    if (!ctx->baseline) {
+        fclose(fp);
+        ctx->baseline_time = 0;
+        return set_error(ctx, FM_ERR_NOMEM, "Memory allocation error");
+    }
+    ctx->baseline_capacity = count > 0 ? count : 1;
+    int ret = FM_OK;
+    for (int i = 0; i < count; i++) {
+        FileInfo *fi = &ctx->baseline[i];
+        int path_len;
+        /* Count entries as they are allocated so fm_baseline_clear() can unwind */
+        ctx->baseline_count = i + 1;
+        if (fread(&path_len, sizeof(int), 1, fp) != 1) {
+            ret = set_error(ctx, FM_ERR_FORMAT, "Baseline file '%s' is corrupted.", path);
+            break;
+        }
+        if (path_len <= 0 || path_len > 4096) {
+            ret = set_error(ctx, FM_ERR_FORMAT, "Baseline file '%s' is corrupted (invalid path length).", path);
+            break;
+        }
+        fi->filepath = malloc(path_len);
+        if (!fi->filepath) {
+            ret = set_error(ctx, FM_ERR_NOMEM, "Memory allocation error");
+            break;
+        }
+        if (fread(fi->filepath, path_len, 1, fp) != 1 ||
+            fread(&fi->mtime, sizeof(time_t), 1, fp) != 1 ||
+            fread(&fi->size, sizeof(off_t), 1, fp) != 1 ||
+            fread(fi->md5, MD5_DIGEST_LENGTH, 1, fp) != 1) {
+            ret = set_error(ctx, FM_ERR_FORMAT, "Baseline file '%s' is corrupted.", path);
+            break;
+        }
+        fi->filepath[path_len - 1] = '\0';
+    }
+    fclose(fp);
+    if (ret == FM_OK && !hash_table_build(ctx)) {
+        ret = set_error(ctx, FM_ERR_NOMEM, "Memory allocation error (hash table)");
+    }
+    if (ret != FM_OK) {
+        fm_baseline_clear(ctx);
+    }
+    return ret;
+}
+
+int fm_check_begin(fm_ctx *ctx) {
+    if (ctx->baseline_time == 0) {
+        return set_error(ctx, FM_ERR_STATE, "No baseline loaded");
+    }
+    if (ctx->index_stale || !ctx->file_checked) {
+        if (!hash_table_build(ctx)) {
+            return set_error(ctx, FM_ERR_NOMEM, "Memory allocation error (hash table)");
+        }
+    } else {
+        memset(ctx->file_checked, 0, (ctx->baseline_count > 0 ? ctx->baseline_count : 1) * sizeof(int));
+    }
+    memset(&ctx->stats, 0, sizeof(ctx->stats));
+    ctx->mode = FM_MODE_CHECK;
+    return FM_OK;
+}
+
+int fm_check_scan(fm_ctx *ctx, const char *dir) {
+    if (ctx->mode != FM_MODE_CHECK) {
+        return set_error(ctx, FM_ERR_STATE, "fm_check_begin() has not been called");
+    }
+    return walk(ctx, dir);
+}
+
+int fm_check_finish(fm_ctx *ctx) {
+    if (ctx->mode != FM_MODE_CHECK) {
+        return set_error(ctx, FM_ERR_STATE, "fm_check_begin() has not been called");
+    }
+    for (int i = 0; i < ctx->baseline_count; i++) {
+        const FileInfo *fi = &ctx->baseline[i];
+        if (ctx->file_checked[i] || is_user_excluded(ctx, fi->filepath)) continue;
+        fm_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.type = FM_EVENT_DELETED;
+        ev.path = fi->filepath;
+        ev.old_mtime = fi->mtime;
+        ev.old_size = fi->size;
+        memcpy(ev.old_md5, fi->md5, MD5_DIGEST_LENGTH);
+        ctx->stats.deleted++;
+        emit(ctx, &ev);
+    }
+    ctx->mode = FM_MODE_IDLE;
+    return FM_OK;
+}
+
+int fm_check_paths(fm_ctx *ctx, const char *const *dirs, int ndirs, fm_results *out) {
+    int r = fm_check_begin(ctx);
+    if (r != FM_OK) return r;
+    ctx->collect = out;
+    ctx->collect_failed = 0;
+    for (int i = 0; i < ndirs && r == FM_OK; i++) {
+        r = fm_check_scan(ctx, dirs[i]);
+    }
+    if (r == FM_OK) {
+        r = fm_check_finish(ctx);
+    } else {
+        ctx->mode = FM_MODE_IDLE;
+    }
+    ctx->collect = NULL;
+    if (r == FM_OK && ctx->collect_failed) {
+        r = set_error(ctx, FM_ERR_NOMEM, "Memory allocation error (results)");
+    }
+    return r;
+}
+
+void fm_results_free(fm_results *res) {
+    if (!res) return;
+    for (size_t i = 0; i < res->count; i++) free((char *)res->events[i].path);
+    free(res->events);
+    res->events = NULL;
+    res->count = 0;
+    res->capacity = 0;
+}
+
+const fm_stats *fm_get_stats(const fm_ctx *ctx) {
+    return &ctx->stats;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2025 BitFigther
+ * Licensed under the MIT License
+ */
+
+#ifndef LIBFM_H
+#define LIBFM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FM_MD5_LEN 16
+
+/* Return codes. Anything other than FM_OK leaves a message in fm_last_error(). */
+#define FM_OK          0
+#define FM_ERR_NOMEM  -1  /* memory allocation failed */
+#define FM_ERR_NOENT  -2  /* baseline file could not be opened */
+#define FM_ERR_FORMAT -3  /* baseline file has bad magic, version or contents */
+#define FM_ERR_IO     -4  /* baseline file could not be written */
+#define FM_ERR_SCAN   -5  /* directory walk failed */
+#define FM_ERR_STATE  -6  /* call not valid in the current context state */
+
+/* Bits in fm_event.changed for FM_EVENT_CHANGED */
+#define FM_CHANGED_MTIME 0x1
+#define FM_CHANGED_SIZE  0x2
+#define FM_CHANGED_MD5   0x4
+
+typedef enum {
+    FM_EVENT_CHANGED,     /* file exists in baseline but mtime/size/MD5 differ */
+    FM_EVENT_NEW,         /* file not present in baseline */
+    FM_EVENT_DELETED,     /* baseline file not seen during the check */
+    FM_EVENT_UNREADABLE,  /* file could not be opened (counted as unverified) */
+    FM_EVENT_HASH_FAILED  /* MD5 computation failed (counted as unverified) */
+} fm_event_type;
+
+/*
+ * A single scan result. `path` is only valid for the duration of the
+ * callback; copy it if it must outlive the call. Fields that do not apply
+ * to `type` are zero: old_* is set for CHANGED/DELETED, new_* for
+ * CHANGED/NEW.
+ */
+typedef struct {
+    fm_event_type type;
+    const char *path;
+    unsigned int changed; /* FM_CHANGED_* bits */
+    time_t old_mtime;
+    time_t new_mtime;
+    off_t old_size;
+    off_t new_size;
+    unsigned char old_md5[FM_MD5_LEN];
+    unsigned char new_md5[FM_MD5_LEN];
+} fm_event;
+
+typedef void (*fm_event_cb)(const fm_event *ev, void *user);
+
+/* Counters for the current baseline scan or check. */
+typedef struct {
+    int files_scanned; /* regular files hashed successfully */
+    int changed;
+    int added;
+    int deleted;
+    int unverified;    /* files skipped due to read/hash failure */
+} fm_stats;
+
+/* Batched results owned by the caller; release with fm_results_free(). */
+typedef struct {
+    fm_event *events; /* each events[i].path is heap-allocated */
+    size_t count;
+    size_t capacity;
+} fm_results;
+
+typedef struct fm_ctx fm_ctx;
+
+/*
+ * Context lifecycle. A context holds one baseline, the exclude patterns and
+ * the per-check state; it has no global state, so independent contexts may
+ * be used from different threads.
+ */
+fm_ctx *fm_ctx_new(void);
+void fm_ctx_free(fm_ctx *ctx);
+const char *fm_last_error(const fm_ctx *ctx);
+
+/* Adds comma-separated fnmatch() patterns, matched against full path and basename. */
+int fm_add_exclude_patterns(fm_ctx *ctx, const char *csv);
+void fm_clear_exclude_patterns(fm_ctx *ctx);
+
+/* Event callback used by baseline scans and checks; NULL disables it. */
+void fm_set_event_callback(fm_ctx *ctx, fm_event_cb cb, void *user);
+
+/*
+ * Baseline management. fm_baseline_scan() appends the files under `dir` to
+ * the in-memory baseline; call fm_baseline_clear() first to start over.
+ * fm_baseline_load() replaces the in-memory baseline with the file's contents.
+ */
+int fm_baseline_load(fm_ctx *ctx, const char *path);
+int fm_baseline_save(fm_ctx *ctx, const char *path);
+int fm_baseline_scan(fm_ctx *ctx, const char *dir);
+void fm_baseline_clear(fm_ctx *ctx);
+int fm_baseline_count(const fm_ctx *ctx);
+time_t fm_baseline_time(const fm_ctx *ctx);
+
+/*
+ * Checking against the loaded baseline:
+ *   fm_check_begin()  resets the seen flags and stats,
+ *   fm_check_scan()   walks one directory (may be called repeatedly),
+ *   fm_check_finish() reports baseline files not seen as deleted.
+ * The baseline stays loaded, so the sequence can be repeated cheaply.
+ */
+int fm_check_begin(fm_ctx *ctx);
+int fm_check_scan(fm_ctx *ctx, const char *dir);
+int fm_check_finish(fm_ctx *ctx);
+
+/*
+ * Runs a full begin/scan/finish check over `dirs` and appends every event to
+ * `out` (in addition to invoking the callback, if one is set). On a scan
+ * error the deleted-file pass is skipped and FM_ERR_SCAN is returned.
+ */
+int fm_check_paths(fm_ctx *ctx, const char *const *dirs, int ndirs, fm_results *out);
+void fm_results_free(fm_results *res);
+
+const fm_stats *fm_get_stats(const fm_ctx *ctx);
+
+/* Writes the 32-char lowercase hex form of md5 plus a terminating NUL. */
+void fm_md5_to_string(const unsigned char *md5, char *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBFM_H */
@@ -0,0 +1,153 @@
+/*
+ * Unit tests for libfm (reentrant fm core)
+ * Usage: ./build/test_libfm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include "libfm.h"
+
+static int pass_count = 0;
+static int fail_count = 0;
+
+static char tmpdir_base[512];
+static char testdir[1024];
+static char baseline_path[1024];
+
+#define CHECK(desc, cond) do {                              \
+        if (cond) { printf("  PASS: %s\n", desc); pass_count++; } \
+        else { printf("  FAIL: %s\n", desc); fail_count++; }      \
+    } while (0)
+
+static void write_file(const char *name, const char *content) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", testdir, name);
+    FILE *fp = fopen(path, "w");
+    if (!fp) { perror(path); exit(1); }
+    fputs(content, fp);
+    fclose(fp);
+}
+
+static void remove_file(const char *name) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", testdir, name);
+    unlink(path);
+}
+
+static int count_type(const fm_results *res, fm_event_type type) {
+    int n = 0;
+    for (size_t i = 0; i < res->count; i++) {
+        if (res->events[i].type == type) n++;
+    }
+    return n;
+}
+
+static void count_cb(const fm_event *ev, void *user) {
+    (void)ev;
+    (*(int *)user)++;
+}
+
+static void cleanup(void) {
+    char cmd[PATH_MAX + 16];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", tmpdir_base);
+    if (system(cmd) != 0) fprintf(stderr, "cleanup failed: %s\n", tmpdir_base);
+}
+
+int main(void) {
+    const char *home = getenv("HOME");
+    snprintf(tmpdir_base, sizeof(tmpdir_base), "%s/fm_libtest_XXXXXX", home ? home : "/var/tmp");
+    if (!mkdtemp(tmpdir_base)) { perror("mkdtemp"); return 1; }
+    atexit(cleanup);
+    snprintf(testdir, sizeof(testdir), "%s/testdir", tmpdir_base);
+    snprintf(baseline_path, sizeof(baseline_path), "%s/baseline.dat", tmpdir_base);
+    mkdir(testdir, 0755);
+    write_file("a.txt", "hello\n");
+    write_file("b.txt", "world\n");
+    write_file("app.log", "log\n");
+
+    const char *dirs[] = { testdir };
+
+    printf("=== libfm tests ===\n\n");
+
+    /* ---- 1. Baseline scan and save ---- */
+    printf("--- 1. Baseline scan and save ---\n");
+    fm_ctx *ctx = fm_ctx_new();
+    CHECK("context created", ctx != NULL);
+    CHECK("baseline scan ok", fm_baseline_scan(ctx, testdir) == FM_OK);
+    CHECK("baseline has 3 files", fm_baseline_count(ctx) == 3);
+    CHECK("baseline save ok", fm_baseline_save(ctx, baseline_path) == FM_OK);
+    fm_ctx_free(ctx);
+
+    /* ---- 2. Load and check with no changes ---- */
+    printf("--- 2. Load and check with no changes ---\n");
+    ctx = fm_ctx_new();
+    CHECK("baseline load ok", fm_baseline_load(ctx, baseline_path) == FM_OK);
+    CHECK("loaded 3 files", fm_baseline_count(ctx) == 3);
+    fm_results res = {0};
+    CHECK("check ok", fm_check_paths(ctx, dirs, 1, &res) == FM_OK);
+    CHECK("no events", res.count == 0);
+    CHECK("3 files scanned", fm_get_stats(ctx)->files_scanned == 3);
+    fm_results_free(&res);
+
+    /* ---- 3. Repeated checks reuse the loaded baseline ---- */
+    printf("--- 3. Repeated checks on one context ---\n");
+    write_file("a.txt", "modified\n");
+    remove_file("b.txt");
+    write_file("new.txt", "new\n");
+    CHECK("check ok", fm_check_paths(ctx, dirs, 1, &res) == FM_OK);
+    CHECK("one changed event", count_type(&res, FM_EVENT_CHANGED) == 1);
+    CHECK("one new event", count_type(&res, FM_EVENT_NEW) == 1);
+    CHECK("one deleted event", count_type(&res, FM_EVENT_DELETED) == 1);
+    CHECK("stats match events",
+          fm_get_stats(ctx)->changed == 1 && fm_get_stats(ctx)->added == 1 &&
+          fm_get_stats(ctx)->deleted == 1);
+    fm_results_free(&res);
+    CHECK("second check ok", fm_check_paths(ctx, dirs, 1, &res) == FM_OK);
+    CHECK("second check reports same 3 events", res.count == 3);
+    fm_results_free(&res);
+
+    /* ---- 4. Callback API ---- */
+    printf("--- 4. Callback API ---\n");
+    int ncb = 0;
+    fm_set_event_callback(ctx, count_cb, &ncb);
+    CHECK("check begin ok", fm_check_begin(ctx) == FM_OK);
+    CHECK("check scan ok", fm_check_scan(ctx, testdir) == FM_OK);
+    CHECK("check finish ok", fm_check_finish(ctx) == FM_OK);
+    CHECK("callback saw 3 events", ncb == 3);
+    fm_set_event_callback(ctx, NULL, NULL);
+
+    /* ---- 5. Exclude patterns ---- */
+    printf("--- 5. Exclude patterns ---\n");
+    write_file("app.log", "modified log\n");
+    CHECK("add patterns ok", fm_add_exclude_patterns(ctx, "*.log,new.txt") == FM_OK);
+    CHECK("check ok", fm_check_paths(ctx, dirs, 1, &res) == FM_OK);
+    CHECK("excluded files not reported",
+          count_type(&res, FM_EVENT_NEW) == 0 && res.count == 2);
+    fm_results_free(&res);
+    fm_clear_exclude_patterns(ctx);
+
+    /* ---- 6. Errors ---- */
+    printf("--- 6. Errors ---\n");
+    char corrupt[1024];
+    snprintf(corrupt, sizeof(corrupt), "%s/corrupt.dat", tmpdir_base);
+    FILE *fp = fopen(corrupt, "w");
+    fputs("CORRUPTED_DATA\n", fp);
+    fclose(fp);
+    CHECK("corrupt baseline -> FM_ERR_FORMAT", fm_baseline_load(ctx, corrupt) == FM_ERR_FORMAT);
+    CHECK("error message set", strstr(fm_last_error(ctx), "invalid format") != NULL);
+    CHECK("check without baseline -> FM_ERR_STATE", fm_check_begin(ctx) == FM_ERR_STATE);
+    CHECK("missing baseline -> FM_ERR_NOENT",
+          fm_baseline_load(ctx, "/nonexistent/fm_baseline.dat") == FM_ERR_NOENT);
+    CHECK("reload ok", fm_baseline_load(ctx, baseline_path) == FM_OK);
+    const char *bad_dirs[] = { "/nonexistent/fm_dir" };
+    CHECK("missing dir -> FM_ERR_SCAN", fm_check_paths(ctx, bad_dirs, 1, &res) == FM_ERR_SCAN);
+    fm_results_free(&res);
+    fm_ctx_free(ctx);
+
+    printf("\n=== Results: %d passed, %d failed ===\n", pass_count, fail_count);
+    return fail_count == 0 ? 0 : 1;
+}